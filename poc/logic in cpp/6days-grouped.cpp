@@ -2,11 +2,13 @@
 #include <vector>
 #include <string>
 #include <cstdlib>
-#include <ctime>
+#include <cstdint>
 #include <map>
 #include <iomanip>
 #include <algorithm>
 
+#include "counter_rng.h"
+
 class Subject
 {
 public:
@@ -165,9 +167,16 @@ void generateTimetable(std::vector<Section> &sections, const std::vector<Subject
     }
 }
 
-int main()
+int main(int argc, char *argv[])
 {
-    std::srand(std::time(nullptr));
+    // Runs are reproducible: pass a seed as the first argument to vary the input data
+    std::uint64_t seed = 42;
+    if (argc > 1 && !parseSeed(argv[1], seed))
+    {
+        std::cerr << "Invalid seed: " << argv[1] << '\n';
+        return 1;
+    }
+    CounterRng rng(seed);
 
     // Predefined subjects
     std::vector<Subject> subjects = {
@@ -191,10 +200,10 @@ int main()
     // Assign subjects to teachers randomly
     for (auto &teacher : teachers)
     {
-        int numSubjects = rand() % 3 + 1; // Each teacher teaches at least 1 subject, up to 3 subjects
+        int numSubjects = rng.nextBelow(3) + 1; // Each teacher teaches at least 1 subject, up to 3 subjects
         for (int i = 0; i < numSubjects; ++i)
         {
-            int subjectIndex = rand() % subjects.size();
+            std::size_t subjectIndex = rng.nextBelow(subjects.size());
             teacher.addSubject(subjects[subjectIndex]);
         }
     }
@@ -213,7 +222,7 @@ int main()
     int teacherIndex = 0;
     for (auto &section : sections)
     {
-        int numTeachers = rand() % 5 + 5; // Each section has 5-9 teachers
+        int numTeachers = rng.nextBelow(5) + 5; // Each section has 5-9 teachers
         for (int i = 0; i < numTeachers; ++i)
         {
             section.addTeacher(teachers[teacherIndex % teachers.size()]);
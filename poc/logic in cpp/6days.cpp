@@ -2,11 +2,22 @@
 #include <vector>
 #include <string>
 #include <cstdlib>
+#include <cstdint>
 #include <ctime>
+#include <cctype>
 #include <map>
+#include <unordered_map>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <thread>
+#include <atomic>
+#include <tuple>
 #include <iomanip>
 #include <algorithm>
 
+#include "counter_rng.h"
+
 class Subject
 {
 public:
@@ -98,6 +109,28 @@ public:
         schedule[year][section.name].push_back({timeSlot, teacher, subject, section});
     }
 
+    // Writes one tab-separated line per class: year, section, time slot, teacher, subject
+    bool saveSnapshot(const std::string &path) const
+    {
+        std::ofstream out(path);
+        if (!out)
+        {
+            return false;
+        }
+        for (const auto &yearEntry : schedule)
+        {
+            for (const auto &sectionEntry : yearEntry.second)
+            {
+                for (const auto &scheduledClass : sectionEntry.second)
+                {
+                    out << yearEntry.first << '\t' << sectionEntry.first << '\t' << scheduledClass.timeSlot << '\t'
+                        << scheduledClass.teacher.name << '\t' << scheduledClass.subject.name << '\n';
+                }
+            }
+        }
+        return static_cast<bool>(out);
+    }
+
     void displayTimetable() const
     {
         for (const auto &yearEntry : schedule)
@@ -129,63 +162,846 @@ public:
     }
 };
 
+// Section names repeat across years, so sections are identified by year and name
+std::string sectionLabel(int year, const std::string &sectionName)
+{
+    return "Year " + std::to_string(year) + "/" + sectionName;
+}
+
 std::vector<std::string> generateTimeSlots()
 {
     return {"09:00-10:00", "10:00-11:00", "11:00-12:00", "12:00-01:00", "01:00-02:00", "02:00-03:00", "03:00-04:00"};
 }
 
-void generateTimetable(std::vector<Year> &years, const std::vector<Subject> &subjects, Timetable &timetable, std::map<std::string, std::map<std::string, bool>> &teacherAvailability, std::map<std::string, std::map<std::string, bool>> &sectionAvailability)
+// Symmetry classes found before generation. Teachers with the same subject set are
+// interchangeable when filling a section, and sections of a year with the same
+// teacher pool can be swapped without changing the quality of a timetable.
+struct SymmetryClasses
+{
+    std::map<std::string, int> teacherClass;              // teacher name -> class id
+    std::vector<std::vector<std::string>> sectionClasses; // equivalent sections, labelled "Year N/X"
+};
+
+SymmetryClasses detectSymmetry(const std::vector<Year> &years)
+{
+    SymmetryClasses symmetry;
+    std::map<std::vector<std::string>, int> teacherSignatures;
+    std::map<std::pair<int, std::vector<std::string>>, std::vector<std::string>> sectionSignatures;
+
+    for (const auto &year : years)
+    {
+        for (const auto &section : year.sections)
+        {
+            std::vector<std::string> pool;
+            for (const auto &teacher : section.teachers)
+            {
+                std::vector<std::string> signature;
+                for (const auto &subject : teacher.subjects)
+                {
+                    signature.push_back(subject.name);
+                }
+                std::sort(signature.begin(), signature.end());
+                signature.erase(std::unique(signature.begin(), signature.end()), signature.end());
+
+                auto inserted = teacherSignatures.emplace(signature, static_cast<int>(teacherSignatures.size()));
+                symmetry.teacherClass[teacher.name] = inserted.first->second;
+                pool.push_back(teacher.name);
+            }
+            std::sort(pool.begin(), pool.end());
+            sectionSignatures[{year.yearNumber, pool}].push_back(sectionLabel(year.yearNumber, section.name));
+        }
+    }
+
+    for (const auto &entry : sectionSignatures)
+    {
+        if (entry.second.size() > 1)
+        {
+            symmetry.sectionClasses.push_back(entry.second);
+        }
+    }
+    return symmetry;
+}
+
+// State shared by the constraint policies while a timetable is being generated
+struct SchedulingState
+{
+    std::map<std::string, std::map<std::string, bool>> &teacherAvailability;
+    std::map<std::string, bool> assignedSubjects; // subjects already given to the current section
+};
+
+// A candidate class: one teacher teaching one subject to a section in a time slot
+struct Placement
+{
+    int year;
+    const Section &section;
+    const std::string &timeSlot;
+    const Teacher &teacher;
+    const Subject &subject;
+};
+
+// Constraint policies. The solver holds one object of each, so a policy can keep its own
+// bookkeeping and a stateless policy takes no space. Each policy provides:
+//   check(state, placement) - false if the placement violates a hard constraint
+//   delta(state, placement) - soft cost added by the placement (lower is better)
+//   apply(state, placement) - bookkeeping once the placement is accepted
+//   isSoft                  - true if the policy only contributes to delta
+//   persistsForSection      - true if a failed check depends only on the section and
+//                             subject, and stays failed until the section is complete
+// A section never gets two classes in one slot; the solver checks that once per slot.
+struct TeacherFree
+{
+    static constexpr bool isSoft = false;
+    static constexpr bool persistsForSection = false;
+
+    bool check(const SchedulingState &state, const Placement &placement) const
+    {
+        auto teacher = state.teacherAvailability.find(placement.teacher.name);
+        if (teacher == state.teacherAvailability.end())
+        {
+            return true;
+        }
+        auto slot = teacher->second.find(placement.timeSlot);
+        return slot == teacher->second.end() || !slot->second;
+    }
+    int delta(const SchedulingState &, const Placement &) const { return 0; }
+    void apply(SchedulingState &state, const Placement &placement)
+    {
+        state.teacherAvailability[placement.teacher.name][placement.timeSlot] = true;
+    }
+};
+
+struct SubjectNotRepeated
 {
+    static constexpr bool isSoft = false;
+    static constexpr bool persistsForSection = true;
+
+    bool check(const SchedulingState &state, const Placement &placement) const
+    {
+        return !state.assignedSubjects.count(placement.subject.name);
+    }
+    int delta(const SchedulingState &, const Placement &) const { return 0; }
+    void apply(SchedulingState &state, const Placement &placement)
+    {
+        state.assignedSubjects[placement.subject.name] = true;
+    }
+};
+
+// Soft constraint: prefer the teacher with the fewest classes so far
+struct BalancedTeacherLoad
+{
+    static constexpr bool isSoft = true;
+    static constexpr bool persistsForSection = false;
+
+    std::map<std::string, int> teacherLoad;
+
+    bool check(const SchedulingState &, const Placement &) const { return true; }
+    int delta(const SchedulingState &, const Placement &placement) const
+    {
+        auto load = teacherLoad.find(placement.teacher.name);
+        return load == teacherLoad.end() ? 0 : load->second;
+    }
+    void apply(SchedulingState &, const Placement &placement)
+    {
+        teacherLoad[placement.teacher.name]++;
+    }
+};
+
+// Checks a single policy, recording whether a failure could clear later in the section
+template <typename Policy>
+bool passes(const Policy &policy, const SchedulingState &state, const Placement &placement, bool &transientFailure)
+{
+    if (policy.check(state, placement))
+    {
+        return true;
+    }
+    transientFailure = transientFailure || !Policy::persistsForSection;
+    return false;
+}
+
+// Generates the timetable under the given constraint policies. The policies are resolved
+// at compile time, so a constraint that is not listed costs nothing. Without soft
+// policies the first feasible placement is taken; otherwise the cheapest one is.
+template <typename... Policies>
+void generateTimetable(std::vector<Year> &years, const SymmetryClasses &symmetry, Timetable &timetable, std::map<std::string, std::map<std::string, bool>> &teacherAvailability, std::map<std::string, std::map<std::string, bool>> &sectionAvailability)
+{
+    constexpr bool hasSoftPolicies = (Policies::isSoft || ... || false);
     std::vector<std::string> timeSlots = generateTimeSlots();
+    SchedulingState state{teacherAvailability, {}};
+    std::tuple<Policies...> policies;
 
     for (auto &year : years)
     {
         for (const auto &section : year.sections)
         {
-            std::map<std::string, bool> assignedSubjects;
+            state.assignedSubjects.clear();
+            std::map<int, bool> exhaustedClasses; // teacher classes with no subject left for this section
+            std::map<std::string, bool> &sectionBusy = sectionAvailability[sectionLabel(year.yearNumber, section.name)];
 
             for (const auto &timeSlot : timeSlots)
             {
-                bool classAssigned = false;
-
-                if (sectionAvailability[section.name][timeSlot])
+                bool &slotTaken = sectionBusy[timeSlot];
+                if (slotTaken)
                 {
                     continue; // Skip if the section is already assigned in this time slot
                 }
 
+                const Teacher *bestTeacher = nullptr;
+                const Subject *bestSubject = nullptr;
+                int bestCost = 0;
+
                 for (const auto &teacher : section.teachers)
                 {
-                    if (teacherAvailability[teacher.name][timeSlot])
+                    int teacherClass = symmetry.teacherClass.at(teacher.name);
+                    if (exhaustedClasses[teacherClass])
                     {
-                        continue; // Skip if the teacher is already assigned in this time slot
+                        continue; // Skip if an equivalent teacher already had no subject left for this section
                     }
 
+                    bool transientFailure = false;
+                    bool anyFeasible = false;
                     for (const auto &subject : teacher.subjects)
                     {
-                        if (!assignedSubjects[subject.name])
+                        Placement placement{year.yearNumber, section, timeSlot, teacher, subject};
+                        bool feasible = std::apply([&](const Policies &...policy)
+                                                   { return (passes(policy, state, placement, transientFailure) && ... && true); },
+                                                   policies);
+                        if (!feasible)
                         {
-                            timetable.addClass(year.yearNumber, timeSlot, teacher, subject, section);
-                            assignedSubjects[subject.name] = true;
-                            teacherAvailability[teacher.name][timeSlot] = true;
-                            sectionAvailability[section.name][timeSlot] = true;
-                            classAssigned = true;
+                            continue;
+                        }
+                        anyFeasible = true;
+
+                        if constexpr (hasSoftPolicies)
+                        {
+                            int cost = std::apply([&](const Policies &...policy)
+                                                  { return (policy.delta(state, placement) + ... + 0); },
+                                                  policies);
+                            if (!bestTeacher || cost < bestCost)
+                            {
+                                bestTeacher = &teacher;
+                                bestSubject = &subject;
+                                bestCost = cost;
+                            }
+                        }
+                        else
+                        {
+                            bestTeacher = &teacher;
+                            bestSubject = &subject;
                             break;
                         }
                     }
-                    if (classAssigned)
+                    if constexpr (!hasSoftPolicies)
+                    {
+                        if (bestTeacher)
+                        {
+                            break; // Break out of the teacher loop once a class is assigned for this time slot
+                        }
+                    }
+                    if (!anyFeasible && !transientFailure)
+                    {
+                        exhaustedClasses[teacherClass] = true;
+                    }
+                }
+
+                if (bestTeacher)
+                {
+                    Placement placement{year.yearNumber, section, timeSlot, *bestTeacher, *bestSubject};
+                    timetable.addClass(year.yearNumber, timeSlot, *bestTeacher, *bestSubject, section);
+                    std::apply([&](Policies &...policy)
+                               { (policy.apply(state, placement), ...); },
+                               policies);
+                    slotTaken = true;
+                }
+            }
+        }
+    }
+}
+
+// Fixed-size matrix of bits, used by the validator to record occupancy
+class BitMatrix
+{
+public:
+    BitMatrix() : columns(0) {}
+    BitMatrix(std::size_t rows, std::size_t columns) : columns(columns), words((rows * columns + 63) / 64, 0) {}
+
+    bool test(std::size_t row, std::size_t column) const
+    {
+        std::size_t index = row * columns + column;
+        return (words[index / 64] >> (index % 64)) & 1;
+    }
+
+    // Sets the bit and returns its previous value
+    bool testAndSet(std::size_t row, std::size_t column)
+    {
+        bool wasSet = test(row, column);
+        std::size_t index = row * columns + column;
+        words[index / 64] |= std::uint64_t(1) << (index % 64);
+        return wasSet;
+    }
+
+private:
+    std::size_t columns;
+    std::vector<std::uint64_t> words;
+};
+
+struct Violation
+{
+    std::string kind;     // teacher clash, section clash, repeated subject, not qualified, not in section pool, unknown entity, malformed snapshot, unmet quota
+    std::string location; // where the violation was found
+    std::string detail;
+};
+
+// Hard-constraint violations make a timetable invalid; warnings, such as unfilled slots, do not
+struct ValidationReport
+{
+    std::vector<Violation> violations;
+    std::vector<Violation> warnings;
+};
+
+// Checks the hard constraints of a timetable one class at a time. Names are resolved to
+// ids once, and every check is a single bit lookup, so validating n classes takes O(n).
+// Sections with a declared quota (section label -> classes) must reach it; any other
+// section with free slots only produces a warning, since the generator does not promise
+// to fill every slot. This model has no rooms, so there are no room clashes to report.
+class TimetableValidator
+{
+public:
+    TimetableValidator(const std::vector<Year> &years, const std::vector<std::string> &timeSlots, const std::map<std::string, std::size_t> &quotas = {})
+        : slotCount(timeSlots.size())
+    {
+        for (const auto &timeSlot : timeSlots)
+        {
+            slotIds.emplace(timeSlot, slotIds.size());
+        }
+
+        std::vector<std::pair<std::size_t, std::size_t>> teacherSubjects;
+        std::vector<std::vector<std::size_t>> sectionPools;
+        for (const auto &year : years)
+        {
+            for (const auto &section : year.sections)
+            {
+                std::string label = sectionLabel(year.yearNumber, section.name);
+                if (!sectionIds.emplace(label, sectionLabels.size()).second)
+                {
+                    continue;
+                }
+                sectionLabels.push_back(label);
+                sectionPools.emplace_back();
+                auto quota = quotas.find(label);
+                sectionQuota.push_back(quota == quotas.end() ? 0 : quota->second);
+
+                for (const auto &teacher : section.teachers)
+                {
+                    std::size_t teacherId = teacherIds.emplace(teacher.name, teacherIds.size()).first->second;
+                    sectionPools.back().push_back(teacherId);
+                    for (const auto &subject : teacher.subjects)
                     {
-                        break; // Break out of the teacher loop once a class is assigned for this time slot
+                        std::size_t subjectId = subjectIds.emplace(subject.name, subjectIds.size()).first->second;
+                        teacherSubjects.emplace_back(teacherId, subjectId);
                     }
                 }
             }
         }
+        sectionLoad.assign(sectionLabels.size(), 0);
+
+        teacherBusy = BitMatrix(teacherIds.size(), slotIds.size());
+        sectionBusy = BitMatrix(sectionLabels.size(), slotIds.size());
+        sectionSubjects = BitMatrix(sectionLabels.size(), subjectIds.size());
+        qualified = BitMatrix(teacherIds.size(), subjectIds.size());
+        inPool = BitMatrix(sectionLabels.size(), teacherIds.size());
+        for (const auto &pair : teacherSubjects)
+        {
+            qualified.testAndSet(pair.first, pair.second);
+        }
+        for (std::size_t sectionId = 0; sectionId < sectionPools.size(); ++sectionId)
+        {
+            for (std::size_t teacherId : sectionPools[sectionId])
+            {
+                inPool.testAndSet(sectionId, teacherId);
+            }
+        }
+    }
+
+    void check(const std::string &location, int year, const std::string &sectionName, const std::string &timeSlot, const std::string &teacherName, const std::string &subjectName)
+    {
+        auto slot = slotIds.find(timeSlot);
+        auto section = sectionIds.find(sectionLabel(year, sectionName));
+        auto teacher = teacherIds.find(teacherName);
+        auto subject = subjectIds.find(subjectName);
+        if (slot == slotIds.end() || section == sectionIds.end() || teacher == teacherIds.end() || subject == subjectIds.end())
+        {
+            report.violations.push_back({"unknown entity", location, "class refers to a time slot, section, teacher or subject that is not in the input"});
+            return;
+        }
+
+        if (teacherBusy.testAndSet(teacher->second, slot->second))
+        {
+            report.violations.push_back({"teacher clash", location, teacherName + " already teaches at " + timeSlot});
+        }
+        if (sectionBusy.testAndSet(section->second, slot->second))
+        {
+            report.violations.push_back({"section clash", location, section->first + " already has a class at " + timeSlot});
+        }
+        else
+        {
+            sectionLoad[section->second]++;
+        }
+        if (sectionSubjects.testAndSet(section->second, subject->second))
+        {
+            report.violations.push_back({"repeated subject", location, subjectName + " is already assigned to " + section->first});
+        }
+        if (!qualified.test(teacher->second, subject->second))
+        {
+            report.violations.push_back({"not qualified", location, teacherName + " does not teach " + subjectName});
+        }
+        if (!inPool.test(section->second, teacher->second))
+        {
+            report.violations.push_back({"not in section pool", location, teacherName + " is not a teacher of " + section->first});
+        }
     }
+
+    // Records a problem found outside check(), such as an unreadable snapshot line
+    void addViolation(const Violation &violation)
+    {
+        report.violations.push_back(violation);
+    }
+
+    // Adds the quota violations and unfilled-slot warnings, and returns everything found
+    ValidationReport finish()
+    {
+        for (std::size_t sectionId = 0; sectionId < sectionLabels.size(); ++sectionId)
+        {
+            std::string filled = std::to_string(sectionLoad[sectionId]) + " of ";
+            if (sectionLoad[sectionId] < sectionQuota[sectionId])
+            {
+                report.violations.push_back({"unmet quota", sectionLabels[sectionId], filled + std::to_string(sectionQuota[sectionId]) + " required classes"});
+            }
+            else if (sectionLoad[sectionId] < slotCount)
+            {
+                report.warnings.push_back({"unfilled slots", sectionLabels[sectionId], filled + std::to_string(slotCount) + " slots filled"});
+            }
+        }
+        return report;
+    }
+
+private:
+    std::size_t slotCount;
+    std::unordered_map<std::string, std::size_t> slotIds;
+    std::unordered_map<std::string, std::size_t> sectionIds;
+    std::unordered_map<std::string, std::size_t> teacherIds;
+    std::unordered_map<std::string, std::size_t> subjectIds;
+    std::vector<std::string> sectionLabels;
+    std::vector<std::size_t> sectionQuota;
+    std::vector<std::size_t> sectionLoad;
+    BitMatrix teacherBusy;
+    BitMatrix sectionBusy;
+    BitMatrix sectionSubjects;
+    BitMatrix qualified;
+    BitMatrix inPool;
+    ValidationReport report;
+};
+
+ValidationReport validateTimetable(const Timetable &timetable, const std::vector<Year> &years, const std::map<std::string, std::size_t> &quotas = {})
+{
+    TimetableValidator validator(years, generateTimeSlots(), quotas);
+    for (const auto &yearEntry : timetable.schedule)
+    {
+        for (const auto &sectionEntry : yearEntry.second)
+        {
+            for (const auto &scheduledClass : sectionEntry.second)
+            {
+                std::string location = sectionLabel(yearEntry.first, sectionEntry.first) + " " + scheduledClass.timeSlot;
+                validator.check(location, yearEntry.first, sectionEntry.first, scheduledClass.timeSlot, scheduledClass.teacher.name, scheduledClass.subject.name);
+            }
+        }
+    }
+    return validator.finish();
+}
+
+// Streams a snapshot written by Timetable::saveSnapshot without loading it into a Timetable
+ValidationReport validateSnapshot(const std::string &path, const std::vector<Year> &years, const std::map<std::string, std::size_t> &quotas = {})
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        return {{{"unreadable snapshot", path, "could not open file"}}, {}};
+    }
+
+    TimetableValidator validator(years, generateTimeSlots(), quotas);
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(in, line))
+    {
+        ++lineNumber;
+        std::string location = path + ":" + std::to_string(lineNumber);
+        std::istringstream fields(line);
+        std::string year, sectionName, timeSlot, teacherName, subjectName;
+        if (!std::getline(fields, year, '\t') || !std::getline(fields, sectionName, '\t') || !std::getline(fields, timeSlot, '\t') ||
+            !std::getline(fields, teacherName, '\t') || !std::getline(fields, subjectName))
+        {
+            validator.addViolation({"malformed snapshot", location, "expected 5 tab-separated fields"});
+            continue;
+        }
+        validator.check(location, std::atoi(year.c_str()), sectionName, timeSlot, teacherName, subjectName);
+    }
+    return validator.finish();
 }
 
-int main()
+// One exported document: every class of a section or of a teacher, in time slot order
+struct ExportEntity
 {
-    std::srand(std::time(nullptr));
+    struct Row
+    {
+        int year;
+        std::string sectionName;
+        const Timetable::ScheduledClass *scheduledClass;
+    };
 
+    std::string kind; // "section" or "teacher"
+    std::string name;
+    std::string stem; // unique file name stem within the export
+    std::vector<Row> rows;
+};
+
+struct ExportResult
+{
+    std::vector<std::pair<std::string, std::size_t>> files; // file name -> bytes written
+    std::string error;
+};
+
+// Lower-case file name stem made of letters, digits and dashes
+std::string fileStem(const std::string &kind, const std::string &name)
+{
+    std::string stem;
+    for (char c : kind + "-" + name)
+    {
+        if (std::isalnum(static_cast<unsigned char>(c)))
+        {
+            stem += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        else if (!stem.empty() && stem.back() != '-')
+        {
+            stem += '-';
+        }
+    }
+    while (!stem.empty() && stem.back() == '-')
+    {
+        stem.pop_back();
+    }
+    return stem;
+}
+
+std::string csvField(const std::string &value)
+{
+    if (value.find_first_of(",\"\r\n") == std::string::npos)
+    {
+        return value;
+    }
+    std::string quoted = "\"";
+    for (char c : value)
+    {
+        quoted += c == '"' ? std::string("\"\"") : std::string(1, c);
+    }
+    return quoted + "\"";
+}
+
+std::string jsonString(const std::string &value)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    std::string quoted = "\"";
+    for (char c : value)
+    {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\')
+        {
+            quoted += '\\';
+            quoted += c;
+        }
+        else if (c == '\n')
+        {
+            quoted += "\\n";
+        }
+        else if (c == '\r')
+        {
+            quoted += "\\r";
+        }
+        else if (c == '\t')
+        {
+            quoted += "\\t";
+        }
+        else if (byte < 0x20)
+        {
+            quoted += "\\u00";
+            quoted += hexDigits[byte >> 4];
+            quoted += hexDigits[byte & 0xF];
+        }
+        else
+        {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+// Escapes a TEXT value (RFC 5545 section 3.3.11)
+std::string icsText(const std::string &value)
+{
+    std::string escaped;
+    for (char c : value)
+    {
+        if (c == ',' || c == ';' || c == '\\')
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (c == '\n')
+        {
+            escaped += "\\n";
+        }
+        else if (c == '\t' || static_cast<unsigned char>(c) >= 0x20)
+        {
+            escaped += c; // other control characters are not allowed in TEXT
+        }
+    }
+    return escaped;
+}
+
+// Appends a content line, folded so no line exceeds 75 octets (RFC 5545 section 3.1).
+// Folds never split a UTF-8 character.
+void appendIcsLine(std::string &out, const std::string &line)
+{
+    std::size_t start = 0;
+    std::size_t limit = 75;
+    while (line.size() - start > limit)
+    {
+        std::size_t end = start + limit;
+        while (end > start + 1 && (static_cast<unsigned char>(line[end]) & 0xC0) == 0x80)
+        {
+            --end;
+        }
+        out.append(line, start, end - start);
+        out += "\r\n ";
+        start = end;
+        limit = 74; // the leading space of a continuation line counts towards its length
+    }
+    out.append(line, start, std::string::npos);
+    out += "\r\n";
+}
+
+// "01:00-02:00" -> "130000" for the end of the slot; slots before 09:00 are in the afternoon
+std::string icsTime(const std::string &timeSlot, bool end)
+{
+    int hour = std::atoi(timeSlot.substr(end ? 6 : 0, 2).c_str());
+    int minute = std::atoi(timeSlot.substr(end ? 9 : 3, 2).c_str());
+    if (hour < 9)
+    {
+        hour += 12;
+    }
+    return std::string(hour < 10 ? "0" : "") + std::to_string(hour) + (minute < 10 ? "0" : "") + std::to_string(minute) + "00";
+}
+
+std::string renderCsv(const ExportEntity &entity)
+{
+    std::string out;
+    out.reserve(64 + entity.rows.size() * 96);
+    out += "Time,Year,Section,Teacher,Subject\n";
+    for (const auto &row : entity.rows)
+    {
+        out += row.scheduledClass->timeSlot + ',' + std::to_string(row.year) + ',' + csvField(row.sectionName) + ',' +
+               csvField(row.scheduledClass->teacher.name) + ',' + csvField(row.scheduledClass->subject.name) + '\n';
+    }
+    return out;
+}
+
+std::string renderJson(const ExportEntity &entity)
+{
+    std::string out;
+    out.reserve(128 + entity.rows.size() * 128);
+    out += "{\"kind\":" + jsonString(entity.kind) + ",\"name\":" + jsonString(entity.name) + ",\"classes\":[";
+    for (std::size_t i = 0; i < entity.rows.size(); ++i)
+    {
+        const auto &row = entity.rows[i];
+        out += i ? ",\n" : "\n";
+        out += "{\"time\":" + jsonString(row.scheduledClass->timeSlot) + ",\"year\":" + std::to_string(row.year) +
+               ",\"section\":" + jsonString(row.sectionName) + ",\"teacher\":" + jsonString(row.scheduledClass->teacher.name) +
+               ",\"subject\":" + jsonString(row.scheduledClass->subject.name) + "}";
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+// Each class repeats on every day of the six-day week, starting from termStart (YYYYMMDD).
+// stamp is the UTC time of the export, used as every event's DTSTAMP.
+std::string renderIcs(const ExportEntity &entity, const std::string &termStart, const std::string &stamp)
+{
+    std::string out;
+    out.reserve(128 + entity.rows.size() * 320);
+    out += "BEGIN:VCALENDAR\r\nVERSION:2.0\r\nPRODID:-//Scheduloom//Timetable//EN\r\n";
+    for (std::size_t i = 0; i < entity.rows.size(); ++i)
+    {
+        const auto &row = entity.rows[i];
+        const auto &timeSlot = row.scheduledClass->timeSlot;
+        out += "BEGIN:VEVENT\r\n";
+        appendIcsLine(out, "UID:" + entity.stem + "-" + std::to_string(i) + "@scheduloom");
+        appendIcsLine(out, "DTSTAMP:" + stamp);
+        appendIcsLine(out, "DTSTART:" + termStart + "T" + icsTime(timeSlot, false));
+        appendIcsLine(out, "DTEND:" + termStart + "T" + icsTime(timeSlot, true));
+        out += "RRULE:FREQ=WEEKLY;BYDAY=MO,TU,WE,TH,FR,SA\r\n";
+        appendIcsLine(out, "SUMMARY:" + icsText(row.scheduledClass->subject.name));
+        appendIcsLine(out, "DESCRIPTION:" + icsText(sectionLabel(row.year, row.sectionName) + " with " + row.scheduledClass->teacher.name));
+        out += "END:VEVENT\r\n";
+    }
+    out += "END:VCALENDAR\r\n";
+    return out;
+}
+
+// Renders and writes the three documents of one entity, each with a single write
+ExportResult exportEntity(const ExportEntity &entity, const std::filesystem::path &directory, const std::string &termStart, const std::string &stamp)
+{
+    ExportResult result;
+    std::pair<std::string, std::string> documents[] = {
+        {entity.stem + ".csv", renderCsv(entity)},
+        {entity.stem + ".json", renderJson(entity)},
+        {entity.stem + ".ics", renderIcs(entity, termStart, stamp)}};
+
+    for (const auto &document : documents)
+    {
+        std::ofstream out(directory / document.first, std::ios::binary);
+        out.write(document.second.data(), static_cast<std::streamsize>(document.second.size()));
+        if (!out)
+        {
+            result.error = "could not write " + (directory / document.first).string();
+            return result;
+        }
+        result.files.emplace_back(document.first, document.second.size());
+    }
+    return result;
+}
+
+// Writes a CSV, JSON and iCalendar file for every section and every teacher into directory,
+// spreading the entities over a pool of worker threads, then writes manifest.json.
+// Returns false and prints the failures if any file could not be written.
+bool exportTimetable(const Timetable &timetable, const std::filesystem::path &directory, const std::string &termStart = "20250106")
+{
+    std::map<std::string, std::size_t> slotOrder;
+    for (const auto &timeSlot : generateTimeSlots())
+    {
+        slotOrder.emplace(timeSlot, slotOrder.size());
+    }
+
+    std::vector<ExportEntity> entities;
+    std::map<std::string, ExportEntity> teachers;
+    for (const auto &yearEntry : timetable.schedule)
+    {
+        for (const auto &sectionEntry : yearEntry.second)
+        {
+            ExportEntity section{"section", sectionLabel(yearEntry.first, sectionEntry.first), {}, {}};
+            for (const auto &scheduledClass : sectionEntry.second)
+            {
+                ExportEntity::Row row{yearEntry.first, sectionEntry.first, &scheduledClass};
+                section.rows.push_back(row);
+
+                ExportEntity &teacher = teachers[scheduledClass.teacher.name];
+                teacher.kind = "teacher";
+                teacher.name = scheduledClass.teacher.name;
+                teacher.rows.push_back(row);
+            }
+            entities.push_back(std::move(section));
+        }
+    }
+    for (auto &entry : teachers)
+    {
+        entities.push_back(std::move(entry.second));
+    }
+    for (auto &entity : entities)
+    {
+        std::stable_sort(entity.rows.begin(), entity.rows.end(), [&](const ExportEntity::Row &a, const ExportEntity::Row &b)
+                         { return slotOrder[a.scheduledClass->timeSlot] < slotOrder[b.scheduledClass->timeSlot]; });
+    }
+
+    // Different names can share a stem ("Dr. Smith" and "Dr Smith"), so later entities get a
+    // numeric suffix; every worker then writes to its own files
+    std::map<std::string, bool> stemsInUse{{"manifest", true}};
+    for (auto &entity : entities)
+    {
+        std::string base = fileStem(entity.kind, entity.name);
+        entity.stem = base;
+        for (int suffix = 2; stemsInUse[entity.stem]; ++suffix)
+        {
+            entity.stem = base + "-" + std::to_string(suffix);
+        }
+        stemsInUse[entity.stem] = true;
+    }
+
+    std::time_t now = std::time(nullptr);
+    char stamp[17];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%SZ", std::gmtime(&now));
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        std::cerr << "Could not create " << directory.string() << ": " << error.message() << '\n';
+        return false;
+    }
+
+    std::vector<ExportResult> results(entities.size());
+    std::atomic<std::size_t> nextEntity{0};
+    auto worker = [&]()
+    {
+        for (std::size_t i = nextEntity++; i < entities.size(); i = nextEntity++)
+        {
+            results[i] = exportEntity(entities[i], directory, termStart, stamp);
+        }
+    };
+
+    std::size_t threadCount = std::max<std::size_t>(1, std::min<std::size_t>(std::thread::hardware_concurrency(), entities.size()));
+    std::vector<std::thread> pool;
+    for (std::size_t i = 0; i < threadCount; ++i)
+    {
+        pool.emplace_back(worker);
+    }
+    for (auto &thread : pool)
+    {
+        thread.join();
+    }
+
+    bool ok = true;
+    std::string manifest;
+    manifest.reserve(64 + entities.size() * 256);
+    manifest += "{\"termStart\":" + jsonString(termStart) + ",\"generatedAt\":" + jsonString(stamp) + ",\"entities\":[";
+    for (std::size_t i = 0; i < entities.size(); ++i)
+    {
+        if (!results[i].error.empty())
+        {
+            std::cerr << "Export failed for " << entities[i].kind << ' ' << entities[i].name << ": " << results[i].error << '\n';
+            ok = false;
+        }
+        manifest += i ? ",\n" : "\n";
+        manifest += "{\"kind\":" + jsonString(entities[i].kind) + ",\"name\":" + jsonString(entities[i].name) +
+                    ",\"classes\":" + std::to_string(entities[i].rows.size()) + ",\"files\":[";
+        for (std::size_t j = 0; j < results[i].files.size(); ++j)
+        {
+            manifest += (j ? "," : "") + std::string("{\"file\":") + jsonString(results[i].files[j].first) +
+                        ",\"bytes\":" + std::to_string(results[i].files[j].second) + "}";
+        }
+        manifest += "]}";
+    }
+    manifest += "\n]}\n";
+
+    std::ofstream out(directory / "manifest.json", std::ios::binary);
+    out.write(manifest.data(), static_cast<std::streamsize>(manifest.size()));
+    if (!out)
+    {
+        std::cerr << "Could not write " << (directory / "manifest.json").string() << '\n';
+        ok = false;
+    }
+    return ok;
+}
+
+// Builds a random institution from the predefined subjects and teachers
+std::vector<Year> generateInput(CounterRng &rng)
+{
     // Predefined subjects
     std::vector<Subject> subjects = {
         Subject("Data Structures"), Subject("Algorithms"), Subject("Database Systems"),
@@ -208,10 +1024,10 @@ int main()
     // Assign subjects to teachers randomly
     for (auto &teacher : teachers)
     {
-        int numSubjects = rand() % 3 + 1; // Each teacher teaches at least 1 subject, up to 3 subjects
+        int numSubjects = rng.nextBelow(3) + 1; // Each teacher teaches at least 1 subject, up to 3 subjects
         for (int i = 0; i < numSubjects; ++i)
         {
-            int subjectIndex = rand() % subjects.size();
+            std::size_t subjectIndex = rng.nextBelow(subjects.size());
             teacher.addSubject(subjects[subjectIndex]);
         }
     }
@@ -234,7 +1050,7 @@ int main()
     {
         for (auto &section : year.sections)
         {
-            int numTeachers = rand() % 5 + 5; // Each section has 5-9 teachers
+            int numTeachers = rng.nextBelow(5) + 5; // Each section has 5-9 teachers
             for (int i = 0; i < numTeachers; ++i)
             {
                 section.addTeacher(teachers[teacherIndex % teachers.size()]);
@@ -243,31 +1059,298 @@ int main()
         }
     }
 
+    return years;
+}
+
+Timetable solveTimetable(std::vector<Year> &years, const SymmetryClasses &symmetry, bool balanceLoad)
+{
     // Initialize teacher and section availability maps
     std::map<std::string, std::map<std::string, bool>> teacherAvailability;
     std::map<std::string, std::map<std::string, bool>> sectionAvailability;
-    for (const auto &teacher : teachers)
+    for (const auto &year : years)
     {
-        for (const auto &timeSlot : generateTimeSlots())
+        for (const auto &section : year.sections)
         {
-            teacherAvailability[teacher.name][timeSlot] = false;
+            for (const auto &timeSlot : generateTimeSlots())
+            {
+                sectionAvailability[sectionLabel(year.yearNumber, section.name)][timeSlot] = false;
+                for (const auto &teacher : section.teachers)
+                {
+                    teacherAvailability[teacher.name][timeSlot] = false;
+                }
+            }
         }
     }
-    for (const auto &year : years)
+
+    Timetable timetable;
+    if (balanceLoad)
     {
-        for (const auto &section : year.sections)
+        generateTimetable<TeacherFree, SubjectNotRepeated, BalancedTeacherLoad>(years, symmetry, timetable, teacherAvailability, sectionAvailability);
+    }
+    else
+    {
+        generateTimetable<TeacherFree, SubjectNotRepeated>(years, symmetry, timetable, teacherAvailability, sectionAvailability);
+    }
+    return timetable;
+}
+
+bool hasViolation(const ValidationReport &report, const std::string &kind, const std::string &location)
+{
+    return std::any_of(report.violations.begin(), report.violations.end(), [&](const Violation &violation)
+                       { return violation.kind == kind && violation.location == location; });
+}
+
+// Stress test for the validator. Each random instance is solved, with and without the soft
+// constraint, and must validate cleanly; copies with a known fault injected must report
+// that fault at the right place. Returns the number of failed checks.
+int runStressTest(std::uint64_t seed, std::size_t instances)
+{
+    int failures = 0;
+    auto expect = [&](bool ok, std::size_t instance, const std::string &what)
+    {
+        if (!ok)
         {
-            for (const auto &timeSlot : generateTimeSlots())
+            std::cerr << "Instance " << instance << ": " << what << '\n';
+            ++failures;
+        }
+    };
+    std::string snapshot = (std::filesystem::temp_directory_path() / ("scheduloom-stress-" + std::to_string(seed) + ".tsv")).string();
+
+    for (std::size_t instance = 0; instance < instances; ++instance)
+    {
+        CounterRng rng(seed, 0, instance);
+        std::vector<Year> years = generateInput(rng);
+        Timetable timetable = solveTimetable(years, detectSymmetry(years), instance % 2 == 1);
+        expect(validateTimetable(timetable, years).violations.empty(), instance, "solved timetable has violations");
+
+        // Pick a random class to corrupt
+        std::vector<std::pair<int, std::string>> sections;
+        for (const auto &yearEntry : timetable.schedule)
+        {
+            for (const auto &sectionEntry : yearEntry.second)
+            {
+                sections.emplace_back(yearEntry.first, sectionEntry.first);
+            }
+        }
+        if (sections.empty())
+        {
+            expect(false, instance, "solver scheduled no classes");
+            continue;
+        }
+        auto target = sections[rng.nextBelow(sections.size())];
+        const auto &targetClasses = timetable.schedule[target.first][target.second];
+        std::size_t targetIndex = rng.nextBelow(targetClasses.size());
+        const Timetable::ScheduledClass original = targetClasses[targetIndex];
+        std::string label = sectionLabel(target.first, target.second);
+        std::string location = label + " " + original.timeSlot;
+
+        // The same class twice clashes on teacher, section and subject
+        Timetable duplicated = timetable;
+        duplicated.schedule[target.first][target.second].push_back(original);
+        ValidationReport report = validateTimetable(duplicated, years);
+        expect(hasViolation(report, "teacher clash", location), instance, "duplicate class not reported as a teacher clash");
+        expect(hasViolation(report, "section clash", location), instance, "duplicate class not reported as a section clash");
+        expect(hasViolation(report, "repeated subject", location), instance, "duplicate class not reported as a repeated subject");
+
+        // A subject the teacher does not teach, and a teacher from outside the section's pool
+        std::vector<std::string> pool;
+        std::vector<const Teacher *> allTeachers;
+        for (const auto &year : years)
+        {
+            for (const auto &section : year.sections)
+            {
+                for (const auto &teacher : section.teachers)
+                {
+                    allTeachers.push_back(&teacher);
+                    if (year.yearNumber == target.first && section.name == target.second)
+                    {
+                        pool.push_back(teacher.name);
+                    }
+                }
+            }
+        }
+        for (const Teacher *other : allTeachers)
+        {
+            auto teaches = [&](const Subject &subject)
+            {
+                return std::any_of(original.teacher.subjects.begin(), original.teacher.subjects.end(), [&](const Subject &own)
+                                   { return own.name == subject.name; });
+            };
+            auto foreign = std::find_if_not(other->subjects.begin(), other->subjects.end(), teaches);
+            if (foreign != other->subjects.end())
+            {
+                Timetable unqualified = timetable;
+                unqualified.schedule[target.first][target.second][targetIndex].subject = *foreign;
+                expect(hasViolation(validateTimetable(unqualified, years), "not qualified", location), instance, "unqualified teacher not reported");
+                break;
+            }
+        }
+        for (const Teacher *other : allTeachers)
+        {
+            if (std::find(pool.begin(), pool.end(), other->name) == pool.end())
+            {
+                Timetable outsider = timetable;
+                outsider.schedule[target.first][target.second][targetIndex].teacher = *other;
+                expect(hasViolation(validateTimetable(outsider, years), "not in section pool", location), instance, "teacher outside the pool not reported");
+                break;
+            }
+        }
+
+        // Declared quotas are hard constraints
+        std::size_t scheduled = targetClasses.size();
+        expect(validateTimetable(timetable, years, {{label, scheduled}}).violations.empty(), instance, "met quota reported");
+        expect(hasViolation(validateTimetable(timetable, years, {{label, scheduled + 1}}), "unmet quota", label), instance, "unmet quota not reported");
+
+        // A malformed snapshot line is reported and later lines are still checked
+        std::size_t lines = 0;
+        for (const auto &yearEntry : timetable.schedule)
+        {
+            for (const auto &sectionEntry : yearEntry.second)
+            {
+                lines += sectionEntry.second.size();
+            }
+        }
+        if (!timetable.saveSnapshot(snapshot))
+        {
+            expect(false, instance, "could not write " + snapshot);
+            continue;
+        }
+        {
+            std::ofstream out(snapshot, std::ios::app);
+            out << "not a class\n"
+                << target.first << '\t' << target.second << '\t' << original.timeSlot << '\t' << original.teacher.name << '\t' << original.subject.name << '\n';
+        }
+        report = validateSnapshot(snapshot, years);
+        expect(hasViolation(report, "malformed snapshot", snapshot + ":" + std::to_string(lines + 1)), instance, "malformed snapshot line not reported");
+        expect(hasViolation(report, "teacher clash", snapshot + ":" + std::to_string(lines + 2)), instance, "clash after a malformed line not reported");
+    }
+
+    std::filesystem::remove(snapshot);
+    return failures;
+}
+
+int main(int argc, char *argv[])
+{
+    // Usage: 6days [seed] [--balance-load] [--snapshot FILE] [--export DIR] [--stress N]
+    //   --balance-load  add the BalancedTeacherLoad soft constraint
+    //   --snapshot FILE save the timetable as a snapshot and validate the file instead
+    //   --export DIR    publish per-section and per-teacher documents if the timetable is valid
+    //   --stress N      run the validator stress test on N instances instead
+    bool balanceLoad = false;
+    std::string snapshotPath;
+    std::string exportDirectory;
+    std::size_t stressInstances = 0;
+    // Runs are reproducible: pass a seed to vary the input data
+    std::uint64_t seed = 42;
+    bool seedGiven = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool takesValue = arg == "--snapshot" || arg == "--export" || arg == "--stress";
+        if (takesValue && i + 1 == argc)
+        {
+            std::cerr << arg << " needs a value\n";
+            return 1;
+        }
+
+        std::uint64_t count = 0;
+        if (arg == "--balance-load")
+        {
+            balanceLoad = true;
+        }
+        else if (arg == "--snapshot")
+        {
+            snapshotPath = argv[++i];
+        }
+        else if (arg == "--export")
+        {
+            exportDirectory = argv[++i];
+        }
+        else if (arg == "--stress")
+        {
+            if (!parseSeed(argv[++i], count) || count == 0)
             {
-                sectionAvailability[section.name][timeSlot] = false;
+                std::cerr << "--stress needs a positive instance count\n";
+                return 1;
             }
+            stressInstances = static_cast<std::size_t>(count);
         }
+        else if (!seedGiven && parseSeed(argv[i], seed))
+        {
+            seedGiven = true;
+        }
+        else
+        {
+            std::cerr << (seedGiven ? "Unexpected argument: " : "Invalid seed: ") << arg << '\n';
+            return 1;
+        }
+    }
+
+    if (stressInstances > 0)
+    {
+        int failures = runStressTest(seed, stressInstances);
+        std::cout << "Stress test: " << stressInstances << " instance(s), " << failures << " failed check(s)\n";
+        return failures == 0 ? 0 : 1;
+    }
+
+    CounterRng rng(seed);
+    std::vector<Year> years = generateInput(rng);
+
+    // Detect interchangeable teachers and sections so the generator can skip equivalent choices
+    SymmetryClasses symmetry = detectSymmetry(years);
+    for (const auto &sectionClass : symmetry.sectionClasses)
+    {
+        std::cout << "Equivalent sections:";
+        for (const auto &label : sectionClass)
+        {
+            std::cout << ' ' << label;
+        }
+        std::cout << '\n';
     }
 
     // Generate and display timetable
-    Timetable timetable;
-    generateTimetable(years, subjects, timetable, teacherAvailability, sectionAvailability);
+    Timetable timetable = solveTimetable(years, symmetry, balanceLoad);
     timetable.displayTimetable();
 
+    // Validate the result, from the snapshot file when one is requested
+    ValidationReport report;
+    if (!snapshotPath.empty())
+    {
+        if (!timetable.saveSnapshot(snapshotPath))
+        {
+            std::cerr << "Could not write snapshot to " << snapshotPath << '\n';
+            return 1;
+        }
+        report = validateSnapshot(snapshotPath, years);
+    }
+    else
+    {
+        report = validateTimetable(timetable, years);
+    }
+
+    std::cout << "Validation: " << report.violations.size() << " violation(s), " << report.warnings.size() << " warning(s)\n";
+    for (const auto &violation : report.violations)
+    {
+        std::cout << "  [" << violation.kind << "] " << violation.location << ": " << violation.detail << '\n';
+    }
+    for (const auto &warning : report.warnings)
+    {
+        std::cout << "  [warning: " << warning.kind << "] " << warning.location << ": " << warning.detail << '\n';
+    }
+
+    if (!report.violations.empty())
+    {
+        if (!exportDirectory.empty())
+        {
+            std::cerr << "Not exporting: the timetable violates hard constraints\n";
+        }
+        return 2;
+    }
+
+    // Only valid timetables are published; unfilled-slot warnings do not block the export
+    if (!exportDirectory.empty() && !exportTimetable(timetable, exportDirectory))
+    {
+        return 1;
+    }
     return 0;
 }
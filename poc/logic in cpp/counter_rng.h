@@ -0,0 +1,58 @@
+#ifndef COUNTER_RNG_H
+#define COUNTER_RNG_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+
+// Counter-based random number generator (splitmix64 finaliser over a keyed counter).
+// A stream is fully determined by (seed, workerId, restartId): workers never share
+// state, and a run can be reproduced exactly from its seed.
+class CounterRng
+{
+public:
+    CounterRng(std::uint64_t seed, std::uint64_t workerId = 0, std::uint64_t restartId = 0)
+        : key(mix(seed ^ mix(workerId * 0xD1B54A32D192ED03ULL ^ mix(restartId * 0xABC98388FB8FAC03ULL)))), counter(0) {}
+
+    std::uint64_t next()
+    {
+        return mix(key + ++counter * 0x9E3779B97F4A7C15ULL);
+    }
+
+    // Uniform-enough integer in [0, bound) for the small bounds used here
+    std::size_t nextBelow(std::size_t bound)
+    {
+        return static_cast<std::size_t>(next() % bound);
+    }
+
+private:
+    std::uint64_t key;
+    std::uint64_t counter;
+
+    static std::uint64_t mix(std::uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+// Parses a decimal seed. Returns false for empty, signed, non-numeric or out-of-range input.
+inline bool parseSeed(const char *text, std::uint64_t &seed)
+{
+    if (*text < '0' || *text > '9')
+    {
+        return false;
+    }
+    char *end = nullptr;
+    errno = 0;
+    unsigned long long value = std::strtoull(text, &end, 10);
+    if (errno == ERANGE || *end != '\0')
+    {
+        return false;
+    }
+    seed = value;
+    return true;
+}
+
+#endif